@@ -64,12 +64,14 @@ class Buffer implements DeviceBuffer
         }
     
         $errcode_ret = $ffi->new('cl_int[1]');
+        $call_start = hrtime(true);
         $buffer = $ffi->clCreateBuffer(
             $context->_getId(),
             $flags,
             $size,
             $host_ptr,
             $errcode_ret);
+        Metrics::call('clCreateBuffer',$call_start);
         if($errcode_ret[0]!=OpenCL::CL_SUCCESS) {
             throw new RuntimeException("clCreateBuffer Error errcode=".$errcode_ret[0], $errcode_ret[0]);
         }
@@ -89,12 +91,16 @@ class Buffer implements DeviceBuffer
         if(($flags&OpenCL::CL_MEM_USE_HOST_PTR) && $host_buffer!=NULL) {
             $this->host_buffer = $host_buffer;
         }
+        Metrics::created('Buffer');
     }
 
     public function __destruct()
     {
         if($this->buffer) {
+            Metrics::released('Buffer');
+            $call_start = hrtime(true);
             $errcode_ret = $this->ffi->clReleaseMemObject($this->buffer);
+            Metrics::call('clReleaseMemObject',$call_start);
             $this->buffer = null;
             if($errcode_ret!=OpenCL::CL_SUCCESS) {
                 echo "WARNING: clReleaseMemObject error=$errcode_ret\n";
@@ -163,8 +169,11 @@ class Buffer implements DeviceBuffer
             $wait_events_p = $wait_events->_getIds();
         }
     
+        $command_queue->_flushWrites();
+        $queue_id = $command_queue->_getRawId();
+        $call_start = hrtime(true);
         $errcode_ret = $ffi->clEnqueueReadBuffer(
-            $command_queue->_getId(),
+            $queue_id,
             $this->buffer,
             $blocking_read,
             $offset,
@@ -173,10 +182,12 @@ class Buffer implements DeviceBuffer
             $num_events_in_wait_list,
             $wait_events_p,
             $event_p);
+        Metrics::call('clEnqueueReadBuffer',$call_start);
     
         if($errcode_ret!=OpenCL::CL_SUCCESS) {
             throw new RuntimeException("clEnqueueReadBuffer Error errcode=".$errcode_ret, $errcode_ret);
         }
+        Metrics::bytes('read',$size);
     
         // append event to events
         if($events) {
@@ -317,8 +328,11 @@ class Buffer implements DeviceBuffer
             $wait_events_p  = $wait_events->_getIds();
         }
     
+        $command_queue->_flushWrites();
+        $queue_id = $command_queue->_getRawId();
+        $call_start = hrtime(true);
         $errcode_ret = $ffi->clEnqueueReadBufferRect(
-            $command_queue->_getId(),
+            $queue_id,
             $this->buffer,
             $blocking_read,
             $buffer_offsets,
@@ -332,10 +346,12 @@ class Buffer implements DeviceBuffer
             $num_events_in_wait_list,
             $wait_event_p,
             $event_p);
+        Metrics::call('clEnqueueReadBufferRect',$call_start);
     
         if($errcode_ret!=OpenCL::CL_SUCCESS) {
             throw new RuntimeException("clEnqueueReadBufferRect Error errcode=".$errcode_ret, $errcode_ret);
         }
+        Metrics::bytes('read',$region[0]*$region[1]*$region[2]);
     
         // append event to events
         if($events) {
@@ -371,6 +387,17 @@ class Buffer implements DeviceBuffer
             throw new InvalidArgumentException("Host buffer is too small.", OpenCL::CL_INVALID_VALUE);
         }
         $host_ptr = $host_buffer->addr($host_offset);
+
+        // small non-blocking writes without events are merged into one upload
+        if(!$blocking_write && $events===null && $wait_events===null) {
+            $combiner = $command_queue->_getWriteCombiner();
+            if($combiner!==null && $combiner->append($command_queue,$this,$host_ptr,$size,$offset)) {
+                $this->dtype = $host_buffer->dtype();
+                $this->value_size = $host_buffer->value_size();
+                Metrics::bytes('write',$size);
+                return;
+            }
+        }
     
         $event_p = null;
         if($events) {
@@ -384,8 +411,11 @@ class Buffer implements DeviceBuffer
             $wait_events_p = $wait_events->_getIds();
         }
     
+        $command_queue->_flushWrites();
+        $queue_id = $command_queue->_getRawId();
+        $call_start = hrtime(true);
         $errcode_ret = $ffi->clEnqueueWriteBuffer(
-            $command_queue->_getId(),
+            $queue_id,
             $this->buffer,
             $blocking_write,
             $offset,
@@ -394,10 +424,12 @@ class Buffer implements DeviceBuffer
             $num_events_in_wait_list,
             $wait_events_p,
             $event_p);
+        Metrics::call('clEnqueueWriteBuffer',$call_start);
     
         if($errcode_ret!=OpenCL::CL_SUCCESS) {
             throw new RuntimeException("clEnqueueWriteBuffer Error errcode=".$errcode_ret, $errcode_ret);
         }
+        Metrics::bytes('write',$size);
         $this->dtype = $host_buffer->dtype();
         $this->value_size = $host_buffer->value_size();
     
@@ -542,8 +574,11 @@ class Buffer implements DeviceBuffer
             $wait_events_p = $wait_events->_getIds();
         }
     
+        $command_queue->_flushWrites();
+        $queue_id = $command_queue->_getRawId();
+        $call_start = hrtime(true);
         $errcode_ret = $ffi->clEnqueueWriteBufferRect(
-            $command_queue->_getId(),
+            $queue_id,
             $this->buffer,
             $blocking_write,
             $buffer_offsets,
@@ -557,10 +592,12 @@ class Buffer implements DeviceBuffer
             $num_events_in_wait_list,
             $wait_events_p,
             $event_p);
+        Metrics::call('clEnqueueWriteBufferRect',$call_start);
     
         if($errcode_ret!=OpenCL::CL_SUCCESS) {
             throw new RuntimeException("clEnqueueReadBufferRect Error errcode=".$errcode_ret, $errcode_ret);
         }
+        Metrics::bytes('write',$region[0]*$region[1]*$region[2]);
     
         // append event to events
         if($events) {
@@ -624,8 +661,11 @@ class Buffer implements DeviceBuffer
         //    "event_wait_list is not null");
         //    return;
         //}
+        $command_queue->_flushWrites();
+        $queue_id = $command_queue->_getRawId();
+        $call_start = hrtime(true);
         $errcode_ret = $ffi->clEnqueueFillBuffer(
-            $command_queue->_getId(),
+            $queue_id,
             $this->buffer,
             $pattern_ptr,
             ($pattern_size*($pattern_buffer->value_size())),
@@ -634,10 +674,12 @@ class Buffer implements DeviceBuffer
             $num_events_in_wait_list,
             $wait_events_p,
             $event_p);
+        Metrics::call('clEnqueueFillBuffer',$call_start);
     
         if($errcode_ret!=OpenCL::CL_SUCCESS) {
             throw new RuntimeException("clEnqueueFillBuffer Error errcode=".$errcode_ret, $errcode_ret);
         }
+        Metrics::bytes('fill',$size);
         $this->dtype = $pattern_buffer->dtype();
         $this->value_size = $pattern_buffer->value_size();
     
@@ -678,8 +720,11 @@ class Buffer implements DeviceBuffer
             $wait_events_p = $wait_events->_getIds();
         }
     
+        $command_queue->_flushWrites();
+        $queue_id = $command_queue->_getRawId();
+        $call_start = hrtime(true);
         $errcode_ret = $ffi->clEnqueueCopyBuffer(
-            $command_queue->_getId(),
+            $queue_id,
             $src_buffer->_getId(),
             $this->buffer,
             $src_offset,
@@ -688,10 +733,12 @@ class Buffer implements DeviceBuffer
             $num_events_in_wait_list,
             $wait_events_p,
             $event_p);
+        Metrics::call('clEnqueueCopyBuffer',$call_start);
     
         if($errcode_ret!=OpenCL::CL_SUCCESS) {
             throw new RuntimeException("clEnqueueWriteBuffer Error errcode=".$errcode_ret, $errcode_ret);
         }
+        Metrics::bytes('copy',$size);
         if($this->dtype==0) {
             $this->dtype = $src_buffer->dtype();
             $this->value_size = $src_buffer->value_size();
@@ -831,8 +878,11 @@ class Buffer implements DeviceBuffer
             $wait_events_p = $wait_events->_getIds();
         }
     
+        $command_queue->_flushWrites();
+        $queue_id = $command_queue->_getRawId();
+        $call_start = hrtime(true);
         $errcode_ret = $ffi->clEnqueueCopyBufferRect(
-            $command_queue->_getId(),
+            $queue_id,
             $src_buffer->_getId(),
             $this->buffer,
             $src_origins,
@@ -845,10 +895,12 @@ class Buffer implements DeviceBuffer
             $num_events_in_wait_list,
             $wait_events_p,
             $event_p);
+        Metrics::call('clEnqueueCopyBufferRect',$call_start);
     
         if($errcode_ret!=OpenCL::CL_SUCCESS) {
             throw new RuntimeException("clEnqueueCopyBufferRect Error errcode=".$errcode_ret, $errcode_ret);
         }
+        Metrics::bytes('copy',$region[0]*$region[1]*$region[2]);
     
         // append event to events
         if($events) {
@@ -864,9 +916,11 @@ class Buffer implements DeviceBuffer
         $id = $this->buffer;
     
         $param_value_size_ret = $ffi->new("size_t[1]");
+        $call_start = hrtime(true);
         $errcode_ret = $ffi->clGetMemObjectInfo($id,
                             $param_name,
                             0, NULL, $param_value_size_ret);
+        Metrics::call('clGetMemObjectInfo',$call_start);
         if($errcode_ret!=OpenCL::CL_SUCCESS) {
             throw new RuntimeException("clGetMemObjectInfo Error errcode=".$errcode_ret, $errcode_ret);
         }
@@ -880,9 +934,11 @@ class Buffer implements DeviceBuffer
                 if($size!=$ffi::sizeof($param_value_val)) {
                     throw new RuntimeException("clGetDeviceInfo illegal int size=$size");
                 }
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetMemObjectInfo($id,
                         $param_name,
                         $size, $param_value_val, NULL);
+                Metrics::call('clGetMemObjectInfo',$call_start);
                 if($errcode_ret) {
                     throw new RuntimeException("clGetMemObjectInfo Error2 errcode=$errcode_ret",$errcode_ret);
                 }
@@ -895,9 +951,11 @@ class Buffer implements DeviceBuffer
                 if($size!=$ffi::sizeof($param_value_val)) {
                     throw new RuntimeException("clGetMemObjectInfo illegal size_t size=$size");
                 }
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetMemObjectInfo($id,
                                         $param_name,
                                         $size, $param_value_val, NULL);
+                Metrics::call('clGetMemObjectInfo',$call_start);
                 if($errcode_ret) {
                     throw new RuntimeException("clGetMemObjectInfo Error2 errcode=$errcode_ret");
                 }
@@ -909,9 +967,11 @@ class Buffer implements DeviceBuffer
                 if($size!=$ffi::sizeof($param_value_val)) {
                     throw new RuntimeException("clGetMemObjectInfo illegal cl_bitfield size=$size");
                 }
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetMemObjectInfo($id,
                                         $param_name,
                                         $size, $param_value_val, NULL);
+                Metrics::call('clGetMemObjectInfo',$call_start);
                 if($errcode_ret) {
                     throw new RuntimeException("clGetMemObjectInfo Error2 errcode=$errcode_ret");
                 }
@@ -924,9 +984,11 @@ class Buffer implements DeviceBuffer
                 if($size!=$ffi::sizeof($param_value_val)) {
                     throw new RuntimeException("clGetMemObjectInfo illegal bool size=$size");
                 }
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetMemObjectInfo($id,
                                         $param_name,
                                         $size, $param_value_val, NULL);
+                Metrics::call('clGetMemObjectInfo',$call_start);
                 if($errcode_ret) {
                     throw new RuntimeException("clGetMemObjectInfo Error2 errcode=$errcode_ret");
                 }
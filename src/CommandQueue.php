@@ -4,6 +4,7 @@ namespace Rindow\OpenCL\FFI;
 use Interop\Polite\Math\Matrix\OpenCL;
 use InvalidArgumentException;
 use RuntimeException;
+use LogicException;
 use FFI;
 
 class CommandQueue
@@ -11,6 +12,7 @@ class CommandQueue
     protected FFI $ffi;
     protected ?object $command_queue;
     protected Context $context;
+    protected ?WriteCombiner $write_combiner=null;
 
     public function __construct(FFI $ffi,
         Context $context,
@@ -30,22 +32,40 @@ class CommandQueue
         }
     
         $errcode_ret = $ffi->new('cl_int[1]');
+        $call_start = hrtime(true);
         $command_queue = $ffi->clCreateCommandQueue(
             $context->_getId(),
             $device,
             $properties,
             $errcode_ret);
+        Metrics::call('clCreateCommandQueue',$call_start);
         if($errcode_ret[0]!=OpenCL::CL_SUCCESS) {
             throw new RuntimeException("clCreateCommandQueue Error errcode=".$errcode_ret[0]);
         }
         $this->command_queue = $command_queue;
         $this->context = $context;
+        Metrics::created('CommandQueue');
     }
 
     public function __destruct()
     {
         if($this->command_queue) {
+            Metrics::released('CommandQueue');
+            if($this->write_combiner) {
+                // the staging arenas must outlive the pending uploads
+                try {
+                    $this->write_combiner->flush($this);
+                } catch(RuntimeException $e) {
+                    echo "WARNING: ".$e->getMessage()."\n";
+                }
+                $call_start = hrtime(true);
+                $this->ffi->clFinish($this->command_queue);
+                Metrics::call('clFinish',$call_start);
+                $this->write_combiner = null;
+            }
+            $call_start = hrtime(true);
             $errcode_ret = $this->ffi->clReleaseCommandQueue($this->command_queue);
+            Metrics::call('clReleaseCommandQueue',$call_start);
             $this->command_queue = null;
             if($errcode_ret!=0) {
                 throw new RuntimeException("clReleaseCommandQueue Error errcode=".$errcode_ret);
@@ -53,7 +73,20 @@ class CommandQueue
         }
     }
 
+    /**
+     * Pending combined writes are flushed first, because every command enqueued
+     * on the returned handle must be ordered after them.
+     */
     public function _getId() : object
+    {
+        $this->_flushWrites();
+        return $this->command_queue;
+    }
+
+    /**
+     * The handle without flushing the combined writes.
+     */
+    public function _getRawId() : object
     {
         return $this->command_queue;
     }
@@ -63,11 +96,63 @@ class CommandQueue
         return $this->context;
     }
 
+    /**
+     * Merge small non-blocking writes without events into one upload.
+     * The command queue must be in-order.
+     * The pending writes are flushed by any enqueue of this package and by
+     * _getId(), so libraries that enqueue on the native handle stay ordered.
+     */
+    public function enableWriteCombining(
+        ?int $capacity=null,
+        ?int $max_write_size=null,
+        ) : void
+    {
+        $ffi = $this->ffi;
+        $properties = $ffi->new("cl_command_queue_properties[1]");
+        $call_start = hrtime(true);
+        $errcode_ret = $ffi->clGetCommandQueueInfo($this->command_queue,
+                OpenCL::CL_QUEUE_PROPERTIES,
+                FFI::sizeof($properties), $properties, NULL);
+        Metrics::call('clGetCommandQueueInfo',$call_start);
+        if($errcode_ret!=OpenCL::CL_SUCCESS) {
+            throw new RuntimeException("clGetCommandQueueInfo Error errcode=$errcode_ret",$errcode_ret);
+        }
+        if($properties[0]&OpenCL::CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE) {
+            throw new LogicException("Write combining requires an in-order command queue.");
+        }
+        $this->disableWriteCombining();
+        $this->write_combiner = new WriteCombiner($ffi, $this->context, $capacity, $max_write_size);
+    }
+
+    public function disableWriteCombining() : void
+    {
+        if($this->write_combiner===null) {
+            return;
+        }
+        $this->finish();
+        $this->write_combiner = null;
+    }
+
+    public function _getWriteCombiner() : ?WriteCombiner
+    {
+        return $this->write_combiner;
+    }
+
+    public function _flushWrites() : void
+    {
+        if($this->write_combiner) {
+            $this->write_combiner->flush($this);
+        }
+    }
+
     public function flush() : void
     {
         $ffi = $this->ffi;
+        $this->_flushWrites();
     
+        $call_start = hrtime(true);
         $errcode_ret = $ffi->clFlush($this->command_queue);
+        Metrics::call('clFlush',$call_start);
         if($errcode_ret!=0) {
             throw new RuntimeException("clFlush Error errcode=".$errcode_ret);
         }
@@ -76,11 +161,17 @@ class CommandQueue
     public function finish() : void
     {
         $ffi = $this->ffi;
+        $this->_flushWrites();
 
+        $call_start = hrtime(true);
         $errcode_ret = $ffi->clFinish($this->command_queue);
+        Metrics::call('clFinish',$call_start);
         if($errcode_ret!=0) {
             throw new RuntimeException("clFinish Error errcode=".$errcode_ret);
         }
+        if($this->write_combiner) {
+            $this->write_combiner->_release();
+        }
     }
 
     public function getInfo(int $param_name) : mixed
@@ -88,9 +179,11 @@ class CommandQueue
         $ffi = $this->ffi;
 
         $param_value_size_ret = $ffi->new("size_t[1]");
+        $call_start = hrtime(true);
         $errcode_ret = $ffi->clGetCommandQueueInfo($this->command_queue,
                                 $param_name,
                                 0, NULL, $param_value_size_ret);
+        Metrics::call('clGetCommandQueueInfo',$call_start);
         if($errcode_ret!=OpenCL::CL_SUCCESS) {
             throw new RuntimeException("clGetCommandQueueInfo Error errcode=$errcode_ret");
         }
@@ -101,9 +194,11 @@ class CommandQueue
                 if($size!=$ffi::sizeof($param_value_val)) {
                     throw new RuntimeException("clGetCommandQueueInfo illegal cl_context size=$size");
                 }
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetCommandQueueInfo($this->command_queue,
                         $param_name,
                         $size, $param_value_val, NULL);
+                Metrics::call('clGetCommandQueueInfo',$call_start);
                 if($errcode_ret) {
                     throw new RuntimeException("clGetCommandQueueInfo Error2 errcode=$errcode_ret",$errcode_ret);
                 }
@@ -118,9 +213,11 @@ class CommandQueue
                     throw new RuntimeException("clGetCommandQueueInfo illegal array<size_t> size=$size");
                 }
                 $device_ids = $ffi->new("cl_device_id[$items]");
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetCommandQueueInfo($this->command_queue,
                             $param_name,
                             $size, $device_ids, NULL);
+                Metrics::call('clGetCommandQueueInfo',$call_start);
                 if($errcode_ret) {
                     throw new RuntimeException("clGetCommandQueueInfo Error errcode=$errcode_ret",$errcode_ret);
                 }
@@ -139,9 +236,11 @@ class CommandQueue
                     throw new RuntimeException("clGetCommandQueueInfo illegal array<cl_uint> size=$size");
                 }
                 $properties = $ffi->new("cl_context_properties[$items]");
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetCommandQueueInfo($this->command_queue,
                             $param_name,
                             $size, $properties, NULL);
+                Metrics::call('clGetCommandQueueInfo',$call_start);
                 if($errcode_ret) {
                     throw new RuntimeException("clGetCommandQueueInfo Error errcode=$errcode_ret",$errcode_ret);
                 }
@@ -161,9 +260,11 @@ class CommandQueue
                 if($size!=$ffi::sizeof($uint_result)) {
                     throw new RuntimeException("clGetCommandQueueInfo illegal cl_uint size=$size");
                 }
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetCommandQueueInfo($this->command_queue,
                         $param_name,
                         $size, $uint_result, NULL);
+                Metrics::call('clGetCommandQueueInfo',$call_start);
                 if($errcode_ret) {
                     throw new RuntimeException("clGetCommandQueueInfo Error errcode=$errcode_ret",$errcode_ret);
                 }
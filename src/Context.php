@@ -29,13 +29,16 @@ class Context
             if($errcode_ret!=OpenCL::CL_SUCCESS) {
                 throw new RuntimeException("clGetContextInfo Error errcode=".$errcode_ret);
             }
+            $call_start = hrtime(true);
             $errcode_ret = $ffi->clRetainContext($context);
+            Metrics::call('clRetainContext',$call_start);
             if($errcode_ret!=OpenCL::CL_SUCCESS) {
                 throw new RuntimeException("clRetainContext Error errcode=".$errcode_ret);
             }
             $this->context = $context;
             $this->num_devices = $num_devices;
             $this->devices = $devices;
+            Metrics::created('Context');
             return;
         }
         if($arg instanceof DeviceList) {
@@ -44,6 +47,7 @@ class Context
             $ids = $devices->_getIds();
             $num = count($ids);
             $errcode_ret = $ffi->new('cl_int[1]');
+            $call_start = hrtime(true);
             $context = $ffi->clCreateContext(
                 NULL,       // const cl_context_properties * properties,
                 $num,       // cl_uint  num_devices,
@@ -52,6 +56,7 @@ class Context
                 NULL,       // void *user_data,
                 $errcode_ret  // cl_int *errcode_ret
             );
+            Metrics::call('clCreateContext',$call_start);
             if($errcode_ret[0]!=OpenCL::CL_SUCCESS) {
                 throw new RuntimeException("clCreateContext Error errcode=".$errcode_ret[0]);
             }
@@ -70,9 +75,11 @@ class Context
             $platform = $ffi->new('cl_platform_id[1]');
             $num_platforms = $ffi->new('cl_uint[1]');
     
+            $call_start = hrtime(true);
             $errcode_ret = $ffi->clGetPlatformIDs( 1,   // cl_uint num_entries
                                 $platform,              // cl_platform_id * platforms
                                 $num_platforms );       // cl_uint * num_platforms
+            Metrics::call('clGetPlatformIDs',$call_start);
             if($errcode_ret!=OpenCL::CL_SUCCESS) {
                 throw new RuntimeException("clGetPlatformIDs Error errcode=".$errcode_ret);
             }
@@ -80,6 +87,7 @@ class Context
             FFI::memcpy($int64,$platform,FFI::sizeof($int64));
             $properties[1] = $int64[0];
             $errcode_ret = $ffi->new('cl_int[1]');
+            $call_start = hrtime(true);
             $context = $ffi->clCreateContextFromType(
                 $properties,    // const cl_context_properties * properties,
                 $device_type,   // cl_device_type      device_type,
@@ -87,6 +95,7 @@ class Context
                 NULL,           // void *user_data,
                 $errcode_ret    // cl_int *errcode_ret
             );
+            Metrics::call('clCreateContextFromType',$call_start);
             if($errcode_ret[0]!=OpenCL::CL_SUCCESS) {
                 // static char message[128];
                 // sprintf(message,"clCreateContextFromType Error: device_type=%lld, error=%d",device_type,errcode_ret);
@@ -110,12 +119,16 @@ class Context
         $this->context = $context;
         $this->num_devices = $num_devices;
         $this->devices = $devices;
+        Metrics::created('Context');
     }
 
     public function __destruct()
     {
         if($this->context) {
+            Metrics::released('Context');
+            $call_start = hrtime(true);
             $errcode_ret = $this->ffi->clReleaseContext($this->context);
+            Metrics::call('clReleaseContext',$call_start);
             $this->context = null;
             if($errcode_ret!=OpenCL::CL_SUCCESS) {
                 echo "WARNING: clReleaseContext error=$errcode_ret\n";
@@ -146,12 +159,14 @@ class Context
     {
         $ffi = $this->ffi;
         $n_device = $ffi->new('cl_int[1]');
+        $call_start = hrtime(true);
         $errcode = $ffi->clGetContextInfo(
             $context,
             OpenCL::CL_CONTEXT_NUM_DEVICES,
             FFI::sizeof($n_device),
             $n_device,
             NULL);
+        Metrics::call('clGetContextInfo',$call_start);
         if($errcode!=OpenCL::CL_SUCCESS) {
             $errcode_ret = $errcode;
             return NULL;
@@ -163,12 +178,14 @@ class Context
             return NULL;
         }
         $cl_device_id = $ffi->new('cl_device_id[1]');
+        $call_start = hrtime(true);
         $errcode = $ffi->clGetContextInfo(
             $context,
             OpenCL::CL_CONTEXT_DEVICES,
             $n_device*FFI::sizeof($cl_device_id),
             $devices,
             NULL);
+        Metrics::call('clGetContextInfo',$call_start);
         if($errcode!=OpenCL::CL_SUCCESS) {
             $errcode_ret = $errcode;
             return NULL;
@@ -183,9 +200,11 @@ class Context
         $ffi = $this->ffi;
 
         $param_value_size_ret = $ffi->new("size_t[1]");
+        $call_start = hrtime(true);
         $errcode_ret = $ffi->clGetContextInfo($this->context,
                                 $param_name,
                                 0, NULL, $param_value_size_ret);
+        Metrics::call('clGetContextInfo',$call_start);
         if($errcode_ret!=OpenCL::CL_SUCCESS) {
             throw new RuntimeException("clGetContextInfo Error errcode=$errcode_ret");
         }
@@ -198,9 +217,11 @@ class Context
                     throw new RuntimeException("clGetContextInfo illegal array<size_t> size=$size");
                 }
                 $device_ids = $ffi->new("cl_device_id[$items]");
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetContextInfo($this->context,
                             $param_name,
                             $size, $device_ids, NULL);
+                Metrics::call('clGetContextInfo',$call_start);
                 if($errcode_ret!=OpenCL::CL_SUCCESS) {
                     throw new RuntimeException("clGetContextInfo Error errcode=".$errcode_ret);
                 }
@@ -219,9 +240,11 @@ class Context
                     throw new RuntimeException("clGetContextInfo illegal array<cl_uint> size=$size");
                 }
                 $properties = $ffi->new("cl_context_properties[$items]");
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetContextInfo($this->context,
                             $param_name,
                             $size, $properties, NULL);
+                Metrics::call('clGetContextInfo',$call_start);
                 if($errcode_ret!=OpenCL::CL_SUCCESS) {
                     throw new RuntimeException("clGetContextInfo Error errcode=".$errcode_ret);
                 }
@@ -239,9 +262,11 @@ class Context
                 if($size!=$ffi::sizeof($uint_result)) {
                     throw new RuntimeException("clGetContextInfo illegal cl_uint size=$size");
                 }
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetContextInfo($this->context,
                         $param_name,
                         $size, $uint_result, NULL);
+                Metrics::call('clGetContextInfo',$call_start);
                 if($errcode_ret!=OpenCL::CL_SUCCESS) {
                     throw new RuntimeException("clGetContextInfo Error errcode=".$errcode_ret);
                 }
@@ -39,23 +39,27 @@ class DeviceList implements Countable
         $platforms = $platforms->_getIds();
 
         $numDevices = $ffi->new("unsigned int[1]");
+        $call_start = hrtime(true);
         $errcode_ret = $ffi->clGetDeviceIDs(
                                 $platforms[0],
                                 $device_type,
                                 0,
                                 NULL,
                                 $numDevices);
+        Metrics::call('clGetDeviceIDs',$call_start);
         if($errcode_ret!=OpenCL::CL_SUCCESS) {
             throw new RuntimeException("clGetDeviceIDs Error errcode=$errcode_ret");
         }
         $num = $numDevices[0];
         $devices = $ffi->new("cl_device_id[$num]");
+        $call_start = hrtime(true);
         $errcode_ret = $ffi->clGetDeviceIDs(
                                 $platforms[0],
                                 $device_type,
                                 $num,
                                 $devices,
                                 $numDevices);
+        Metrics::call('clGetDeviceIDs',$call_start);
         if($errcode_ret!=OpenCL::CL_SUCCESS) {
             throw new RuntimeException("clGetDeviceIDs Error2 errcode=$errcode_ret");
         }
@@ -111,11 +115,13 @@ class DeviceList implements Countable
         }
         $id = $this->devices[$offset];
         $param_value_size_ret = $ffi->new("size_t[1]");
+        $call_start = hrtime(true);
         $errcode_ret = $ffi->clGetDeviceInfo($id,
                                 $param_name,
                                 0,
                                 NULL,
                                 $param_value_size_ret);
+        Metrics::call('clGetDeviceInfo',$call_start);
                 
         if($errcode_ret!=OpenCL::CL_SUCCESS) {
             throw new RuntimeException("clGetDeviceInfo Error errcode=$errcode_ret");
@@ -131,9 +137,11 @@ class DeviceList implements Countable
             case OpenCL::CL_DEVICE_BUILT_IN_KERNELS: {
                 $size = $param_value_size_ret[0];
                 $param_value_val = $ffi->new("cl_char[$size]");
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetDeviceInfo($id,
                                         $param_name,
                                         $size, $param_value_val, NULL);
+                Metrics::call('clGetDeviceInfo',$call_start);
                 if($errcode_ret!=OpenCL::CL_SUCCESS) {
                     throw new RuntimeException("clGetDeviceInfo Error2 errcode=$errcode_ret");
                 }
@@ -174,9 +182,11 @@ class DeviceList implements Countable
                 if($size!=$ffi::sizeof($param_value_val)) {
                     throw new RuntimeException("clGetDeviceInfo illegal int size=$size");
                 }
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetDeviceInfo($id,
                                         $param_name,
                                         $size, $param_value_val, NULL);
+                Metrics::call('clGetDeviceInfo',$call_start);
                 if($errcode_ret!=OpenCL::CL_SUCCESS) {
                     throw new RuntimeException("clGetDeviceInfo Error2 errcode=$errcode_ret");
                 }
@@ -192,9 +202,11 @@ class DeviceList implements Countable
                 if($size!=$ffi::sizeof($param_value_val)) {
                     throw new RuntimeException("clGetDeviceInfo illegal long size=$size");
                 }
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetDeviceInfo($id,
                                         $param_name,
                                         $size, $param_value_val, NULL);
+                Metrics::call('clGetDeviceInfo',$call_start);
                 if($errcode_ret!=OpenCL::CL_SUCCESS) {
                     throw new RuntimeException("clGetDeviceInfo Error2 errcode=$errcode_ret");
                 }
@@ -213,9 +225,11 @@ class DeviceList implements Countable
                 if($size!=$ffi::sizeof($param_value_val)) {
                     throw new RuntimeException("clGetDeviceInfo illegal bool size=$size");
                 }
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetDeviceInfo($id,
                                         $param_name,
                                         $size, $param_value_val, NULL);
+                Metrics::call('clGetDeviceInfo',$call_start);
                 if($errcode_ret!=OpenCL::CL_SUCCESS) {
                     throw new RuntimeException("clGetDeviceInfo Error2 errcode=$errcode_ret");
                 }
@@ -237,9 +251,11 @@ class DeviceList implements Countable
                 if($size!=$ffi::sizeof($param_value_val)) {
                     throw new RuntimeException("clGetDeviceInfo illegal size_t size=$size");
                 }
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetDeviceInfo($id,
                                         $param_name,
                                         $size, $param_value_val, NULL);
+                Metrics::call('clGetDeviceInfo',$call_start);
                 if($errcode_ret!=OpenCL::CL_SUCCESS) {
                     throw new RuntimeException("clGetDeviceInfo Error2 errcode=$errcode_ret");
                 }
@@ -255,9 +271,11 @@ class DeviceList implements Countable
                 if($size!=$ffi::sizeof($param_value_val)) {
                     throw new RuntimeException("clGetDeviceInfo illegal cl_bitfield size=$size");
                 }
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetDeviceInfo($id,
                                         $param_name,
                                         $size, $param_value_val, NULL);
+                Metrics::call('clGetDeviceInfo',$call_start);
                 if($errcode_ret!=OpenCL::CL_SUCCESS) {
                     throw new RuntimeException("clGetDeviceInfo Error2 errcode=$errcode_ret");
                 }
@@ -269,9 +287,11 @@ class DeviceList implements Countable
                 if($size!=$ffi::sizeof($param_value_val)) {
                     throw new RuntimeException("clGetDeviceInfo illegal cl_platform_id size=$size");
                 }
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetDeviceInfo($id,
                                         $param_name,
                                         $size, $param_value_val, NULL);
+                Metrics::call('clGetDeviceInfo',$call_start);
                 if($errcode_ret!=OpenCL::CL_SUCCESS) {
                     throw new RuntimeException("clGetDeviceInfo Error2 errcode=$errcode_ret");
                 }
@@ -283,9 +303,11 @@ class DeviceList implements Countable
                 if($size!=$ffi::sizeof($param_value_val)) {
                     throw new RuntimeException("clGetDeviceInfo illegal device_id size=$size");
                 }
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetDeviceInfo($id,
                                         $param_name,
                                         $size, $param_value_val, NULL);
+                Metrics::call('clGetDeviceInfo',$call_start);
                 if($errcode_ret!=OpenCL::CL_SUCCESS) {
                     throw new RuntimeException("clGetDeviceInfo Error2 errcode=$errcode_ret");
                 }
@@ -307,9 +329,11 @@ class DeviceList implements Countable
                 }
                 $items = $size/$sizeofItem;
                 $param_value_val = $ffi->new("size_t[$items]");
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetDeviceInfo($id,
                                         $param_name,
                                         $size, $param_value_val, NULL);
+                Metrics::call('clGetDeviceInfo',$call_start);
                 if($errcode_ret!=OpenCL::CL_SUCCESS) {
                     throw new RuntimeException("clGetDeviceInfo Error2 errcode=$errcode_ret");
                 }
@@ -331,9 +355,11 @@ class DeviceList implements Countable
                 }
                 $items = $size/$sizeofItem;
                 $param_value_val = $ffi->new("cl_device_partition_property[$items]");
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetDeviceInfo($id,
                                         $param_name,
                                         $size, $param_value_val, NULL);
+                Metrics::call('clGetDeviceInfo',$call_start);
                 if($errcode_ret!=OpenCL::CL_SUCCESS) {
                     throw new RuntimeException("clGetDeviceInfo Error2 errcode=$errcode_ret");
                 }
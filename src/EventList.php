@@ -21,12 +21,15 @@ class EventList implements Countable
         if($context===null) {
             $this->num = 0;
             $this->events = null;
+            Metrics::created('EventList');
             return;
         }
         $errcode_ret = $ffi->new('cl_int[1]');
+        $call_start = hrtime(true);
         $event = $ffi->clCreateUserEvent(
             $context->_getId(),
             $errcode_ret);
+        Metrics::call('clCreateUserEvent',$call_start);
         if($errcode_ret[0]!=OpenCL::CL_SUCCESS) {
             throw new RuntimeException("clCreateUserEvent Error errcode=".$errcode_ret[0]);
         }
@@ -34,11 +37,13 @@ class EventList implements Countable
         $events = $ffi->new('cl_event[1]');
         $events[0] = $event;
         $this->events = $events;
+        Metrics::created('EventList');
     }
 
     public function __destruct()
     {
         $this->clear();
+        Metrics::released('EventList');
     }
 
     public function _ffi() : FFI
@@ -67,7 +72,9 @@ class EventList implements Countable
         if($this->events===NULL) {
             throw new RuntimeException("EventList is not initialized");
         }
+        $call_start = hrtime(true);
         $errcode_ret = $ffi->clWaitForEvents($this->num,$this->events);
+        Metrics::call('clWaitForEvents',$call_start);
         if($errcode_ret!=OpenCL::CL_SUCCESS) {
             throw new RuntimeException("clWaitForEvents Error errcode=".$errcode_ret);
         }
@@ -78,7 +85,9 @@ class EventList implements Countable
         $ffi = $this->ffi;
         if($this->events) {
             for($i=0;$i<$this->num;$i++) {
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clReleaseEvent($this->events[$i]);
+                Metrics::call('clReleaseEvent',$call_start);
                 if($errcode_ret!=OpenCL::CL_SUCCESS) {
                     echo "WARNING: clReleaseEvent error=$errcode_ret\n";
                 }
@@ -130,7 +139,9 @@ class EventList implements Countable
         }
         FFI::memcpy(FFI::addr($newEvnets[$this->num]),$eventItems,FFI::sizeof($eventItems));
         for($i=0;$i<$count;$i++) {
+            $call_start = hrtime(true);
             $errcode_ret = $ffi->clRetainEvent($eventItems[$i]);
+            Metrics::call('clRetainEvent',$call_start);
             if($errcode_ret!=OpenCL::CL_SUCCESS) {
                 echo "WARNING: clRetainEvent error=$errcode_ret\n";
             }
@@ -147,9 +158,11 @@ class EventList implements Countable
             throw new OutOfRangeException("event index is out of range");
         }
     
+        $call_start = hrtime(true);
         $errcode_ret = $ffi->clSetUserEventStatus(
             $this->events[$index],
             $execution_status);
+        Metrics::call('clSetUserEventStatus',$call_start);
         if($errcode_ret!=OpenCL::CL_SUCCESS) {
             throw new RuntimeException("clSetUserEventStatus Error errcode=".$errcode_ret);
         }
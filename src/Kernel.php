@@ -30,6 +30,7 @@ class Kernel
 
     protected FFI $ffi;
     protected ?object $kernel;
+    protected string $kernel_name;
     protected int $addressBits;
     protected int $sizeOfDeviceAddress;
 
@@ -44,25 +45,32 @@ class Kernel
         $kernel_name_p = $ffi->new("char[$len]");
         FFI::memcpy($kernel_name_p,$kernel_name."\0",$len);
         $errcode_ret = $ffi->new('cl_int[1]');
+        $call_start = hrtime(true);
         $kernel = $ffi->clCreateKernel(
             $program->_getId(),
             $kernel_name_p,
             $errcode_ret
         );
+        Metrics::call('clCreateKernel',$call_start);
     
         if($errcode_ret[0]!=OpenCL::CL_SUCCESS) {
             throw new RuntimeException("clCreateKernel Error errcode=".$errcode_ret[0], $errcode_ret[0]);
         }
         $this->kernel = $kernel;
+        $this->kernel_name = $kernel_name;
         $deviceList = $program->getInfo(OpenCL::CL_PROGRAM_DEVICES);
         $this->addressBits = $deviceList->getInfo(0,OpenCL::CL_DEVICE_ADDRESS_BITS);
         $this->sizeOfDeviceAddress = intdiv($this->addressBits,8);
+        Metrics::created('Kernel');
     }
 
     public function __destruct()
     {
         if($this->kernel) {
+            Metrics::released('Kernel');
+            $call_start = hrtime(true);
             $errcode_ret = $this->ffi->clReleaseKernel($this->kernel);
+            Metrics::call('clReleaseKernel',$call_start);
             $this->kernel = null;
             if($errcode_ret!=OpenCL::CL_SUCCESS) {
                 echo "WARNING: clReleaseKernel error=$errcode_ret\n";
@@ -109,11 +117,13 @@ class Kernel
             throw new InvalidArgumentException("Invalid argument type", OpenCL::CL_INVALID_VALUE);
         }
     
+        $call_start = hrtime(true);
         $errcode_ret = $ffi->clSetKernelArg(
             $this->kernel,
             $arg_index,
             $arg_size,
             $arg_value);
+        Metrics::call('clSetKernelArg',$call_start);
         if($errcode_ret!=OpenCL::CL_SUCCESS) {
             throw new RuntimeException("clSetKernelArg Error errcode=".$errcode_ret, $errcode_ret);
         }
@@ -190,8 +200,11 @@ class Kernel
             $wait_events_p = $wait_events->_getIds();
         }
 
+        $command_queue->_flushWrites();
+        $queue_id = $command_queue->_getRawId();
+        $call_start = hrtime(true);
         $errcode_ret = $ffi->clEnqueueNDRangeKernel(
-            $command_queue->_getId(),
+            $queue_id,
             $this->kernel,
             $work_dim,
             $global_work_offset_p,
@@ -201,9 +214,11 @@ class Kernel
             $wait_events_p,
             $event_p
         );
+        Metrics::call('clEnqueueNDRangeKernel',$call_start);
         if($errcode_ret!=OpenCL::CL_SUCCESS) {
             throw new RuntimeException("clEnqueueNDRangeKernel Error errcode=".$errcode_ret, $errcode_ret);
         }
+        Metrics::launch($this->kernel_name);
     
         // append event to events
         if($events) {
@@ -218,9 +233,11 @@ class Kernel
         $ffi = $this->ffi;
     
         $param_value_size_ret = $ffi->new("size_t[1]");
+        $call_start = hrtime(true);
         $errcode_ret = $ffi->clGetKernelInfo($this->kernel,
                             $param_name,
                             0, NULL, $param_value_size_ret);
+        Metrics::call('clGetKernelInfo',$call_start);
         if($errcode_ret!=OpenCL::CL_SUCCESS) {
             throw new RuntimeException("clGetKernelInfo Error errcode=".$errcode_ret, $errcode_ret);
         }
@@ -233,9 +250,11 @@ class Kernel
                 if($size!=$ffi::sizeof($param_value_val)) {
                     throw new RuntimeException("clGetDeviceInfo illegal int size=$size");
                 }
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetKernelInfo($this->kernel,
                         $param_name,
                         $size, $param_value_val, NULL);
+                Metrics::call('clGetKernelInfo',$call_start);
                 if($errcode_ret!=OpenCL::CL_SUCCESS) {
                     throw new RuntimeException("clGetKernelInfo Error2 errcode=$errcode_ret",$errcode_ret);
                 }
@@ -247,9 +266,11 @@ class Kernel
             case OpenCL::CL_KERNEL_FUNCTION_NAME: {
                 $size = $param_value_size_ret[0];
                 $param_value_val = $ffi->new("cl_char[$size]");
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetKernelInfo($this->kernel,
                                         $param_name,
                                         $size, $param_value_val, NULL);
+                Metrics::call('clGetKernelInfo',$call_start);
                 if($errcode_ret!=OpenCL::CL_SUCCESS) {
                     throw new RuntimeException("clGetKernelInfo Error2 errcode=$errcode_ret",$errcode_ret);
                 }
@@ -275,9 +296,11 @@ class Kernel
                 if($size!=$ffi::sizeof($param_value_val)) {
                     throw new RuntimeException("clGetDeviceInfo illegal cl_program size=$size");
                 }
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetKernelInfo($this->kernel,
                         $param_name,
                         $size, $param_value_val, NULL);
+                Metrics::call('clGetKernelInfo',$call_start);
                 if($errcode_ret!=OpenCL::CL_SUCCESS) {
                     throw new RuntimeException("clGetKernelInfo Error2 errcode=$errcode_ret",$errcode_ret);
                 }
@@ -305,15 +328,19 @@ class Kernel
         } else {
             $program = $ffi->new("cl_program[1]");
             $size = FFI::sizeof($program);
+            $call_start = hrtime(true);
             $errcode_ret = $ffi->clGetKernelInfo($this->kernel,
                         OpenCL::CL_KERNEL_PROGRAM,
                         $size, $program, NULL);
+            Metrics::call('clGetKernelInfo',$call_start);
             if($errcode_ret!=OpenCL::CL_SUCCESS) {
                 throw new RuntimeException("clGetKernelInfo(CL_KERNEL_PROGRAM) Error2 errcode=$errcode_ret",$errcode_ret);
             }
+            $call_start = hrtime(true);
             $errcode_ret = $ffi->clGetProgramInfo($program[0],
                                 OpenCL::CL_PROGRAM_DEVICES,
                                 0, NULL, $param_value_size_ret);
+            Metrics::call('clGetProgramInfo',$call_start);
             if($errcode_ret!=OpenCL::CL_SUCCESS) {
                 throw new RuntimeException("clGetProgramInfo(CL_PROGRAM_DEVICES) Error2 errcode=$errcode_ret",$errcode_ret);
             }
@@ -327,19 +354,23 @@ class Kernel
             }
             $items = $size/$sizeofItem;
             $device_ids = $ffi->new("cl_device_id[$items]");
+            $call_start = hrtime(true);
             $errcode_ret = $ffi->clGetProgramInfo($program[0],
                         OpenCL::CL_PROGRAM_DEVICES,
                         $size, $device_ids, NULL);
+            Metrics::call('clGetProgramInfo',$call_start);
             if($errcode_ret!=OpenCL::CL_SUCCESS) {
                 throw new RuntimeException("clGetProgramInfo(CL_PROGRAM_DEVICES) Error2 errcode=$errcode_ret",$errcode_ret);
             }
             $device_id = $device_ids[0];
         }
     
+        $call_start = hrtime(true);
         $errcode_ret = $ffi->clGetKernelWorkGroupInfo($this->kernel,
                             $device_id,
                             $param_name,
                             0, NULL, $param_value_size_ret);
+        Metrics::call('clGetKernelWorkGroupInfo',$call_start);
         if($errcode_ret!=OpenCL::CL_SUCCESS) {
             throw new RuntimeException("clGetKernelWorkGroupInfo Error errcode=$errcode_ret",$errcode_ret);
         }
@@ -352,10 +383,12 @@ class Kernel
                 if($size!=$ffi::sizeof($param_value_val)) {
                     throw new RuntimeException("clGetKernelWorkGroupInfo illegal size_t size=$size");
                 }
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetKernelWorkGroupInfo($this->kernel,
                         $device_id,
                         $param_name,
                         $size, $param_value_val, NULL);
+                Metrics::call('clGetKernelWorkGroupInfo',$call_start);
                 if($errcode_ret!=OpenCL::CL_SUCCESS) {
                     throw new RuntimeException("clGetKernelWorkGroupInfo Error errcode=$errcode_ret",$errcode_ret);
                 }
@@ -368,10 +401,12 @@ class Kernel
                 if($size!=$ffi::sizeof($param_value_val)) {
                     throw new RuntimeException("clGetKernelWorkGroupInfo illegal size_t size=$size");
                 }
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetKernelWorkGroupInfo($this->kernel,
                         $device_id,
                         $param_name,
                         $size, $param_value_val, NULL);
+                Metrics::call('clGetKernelWorkGroupInfo',$call_start);
                 if($errcode_ret!=OpenCL::CL_SUCCESS) {
                     throw new RuntimeException("clGetKernelWorkGroupInfo Error2 errcode=$errcode_ret",$errcode_ret);
                 }
@@ -391,10 +426,12 @@ class Kernel
                 }
                 $items = $size/$sizeofItem;
                 $param_value_val = $ffi->new("size_t[$items]");
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetKernelWorkGroupInfo($this->kernel,
                             $device_id,
                             $param_name,
                             $size, $param_value_val, NULL);
+                Metrics::call('clGetKernelWorkGroupInfo',$call_start);
                 if($errcode_ret!=OpenCL::CL_SUCCESS) {
                     throw new RuntimeException("clGetKernelWorkGroupInfo Error2 errcode=$errcode_ret",$errcode_ret);
                 }
@@ -0,0 +1,153 @@
+<?php
+namespace Rindow\OpenCL\FFI;
+
+use InvalidArgumentException;
+
+/**
+ * Cumulative low-overhead counters of the OpenCL wrappers in this process.
+ *
+ * Counts the calls and the host wall time of every OpenCL function called by
+ * the wrappers, including the clGet*Info and clGet*IDs queries.
+ */
+class Metrics
+{
+    /** @var array<string,int> $calls */
+    private static array $calls = [];
+    /** @var array<string,int> $callNanoseconds */
+    private static array $callNanoseconds = [];
+    /** @var array<string,int> $bytes */
+    private static array $bytes = [];
+    /** @var array<string,int> $launches */
+    private static array $launches = [];
+    /** @var array<string,int> $created */
+    private static array $created = [];
+    /** @var array<string,int> $live */
+    private static array $live = [];
+
+    /**
+     * Record a call of the OpenCL function started at hrtime(true).
+     */
+    public static function call(string $function, int $start) : void
+    {
+        $elapsed = hrtime(true) - $start;
+        self::$calls[$function] = (self::$calls[$function] ?? 0) + 1;
+        self::$callNanoseconds[$function] = (self::$callNanoseconds[$function] ?? 0) + $elapsed;
+    }
+
+    /**
+     * Record the bytes moved by read, write, copy or fill.
+     */
+    public static function bytes(string $operation, int $bytes) : void
+    {
+        self::$bytes[$operation] = (self::$bytes[$operation] ?? 0) + $bytes;
+    }
+
+    public static function launch(string $kernel_name) : void
+    {
+        self::$launches[$kernel_name] = (self::$launches[$kernel_name] ?? 0) + 1;
+    }
+
+    public static function created(string $class) : void
+    {
+        self::$created[$class] = (self::$created[$class] ?? 0) + 1;
+        self::$live[$class] = (self::$live[$class] ?? 0) + 1;
+    }
+
+    public static function released(string $class) : void
+    {
+        self::$live[$class] = (self::$live[$class] ?? 0) - 1;
+    }
+
+    /**
+     * @return array{calls:array<string,int>,call_seconds:array<string,float>,bytes:array<string,int>,kernel_launches:array<string,int>,objects_created:array<string,int>,objects_live:array<string,int>}
+     */
+    public static function snapshot() : array
+    {
+        $call_seconds = [];
+        foreach(self::$callNanoseconds as $function => $nanoseconds) {
+            $call_seconds[$function] = $nanoseconds / 1e9;
+        }
+        return [
+            'calls' => self::$calls,
+            'call_seconds' => $call_seconds,
+            'bytes' => self::$bytes,
+            'kernel_launches' => self::$launches,
+            'objects_created' => self::$created,
+            'objects_live' => self::$live,
+        ];
+    }
+
+    /**
+     * Clear the counters. Live object counts are kept because the objects are still alive.
+     */
+    public static function reset() : void
+    {
+        self::$calls = [];
+        self::$callNanoseconds = [];
+        self::$bytes = [];
+        self::$launches = [];
+        self::$created = [];
+    }
+
+    /**
+     * Export the snapshot in the Prometheus text exposition format.
+     *
+     * @param array<string,string> $labels  labels added to all samples. (ex. worker id)
+     */
+    public static function toPrometheus(
+        ?string $prefix=null,
+        ?array $labels=null,
+    ) : string
+    {
+        $prefix = $prefix ?? 'rindow_opencl';
+        $labels = $labels ?? [];
+        if(!preg_match('/^[a-zA-Z_:][a-zA-Z0-9_:]*$/',$prefix)) {
+            throw new InvalidArgumentException("invalid metric name prefix: $prefix");
+        }
+        foreach($labels as $name => $value) {
+            $name = (string)$name;
+            if(!preg_match('/^[a-zA-Z_][a-zA-Z0-9_]*$/',$name) || str_starts_with($name,'__')) {
+                throw new InvalidArgumentException("invalid label name: $name");
+            }
+        }
+        $snapshot = self::snapshot();
+        $families = [
+            // [name, type, help, snapshot key, label name]
+            ['calls_total', 'counter', 'Number of OpenCL function calls.', 'calls', 'function'],
+            ['call_seconds_total', 'counter', 'Host wall time spent inside OpenCL function calls.', 'call_seconds', 'function'],
+            ['transfer_bytes_total', 'counter', 'Bytes moved by Buffer operations.', 'bytes', 'operation'],
+            ['kernel_launches_total', 'counter', 'Number of kernel launches.', 'kernel_launches', 'kernel'],
+            ['objects_created_total', 'counter', 'Number of created objects.', 'objects_created', 'class'],
+            ['objects_live', 'gauge', 'Number of objects not yet destructed.', 'objects_live', 'class'],
+        ];
+        foreach($families as [$name, $type, $help, $key, $label_name]) {
+            if(array_key_exists($label_name,$labels)) {
+                throw new InvalidArgumentException("label name is reserved: $label_name");
+            }
+        }
+        $out = '';
+        foreach($families as [$name, $type, $help, $key, $label_name]) {
+            $name = $prefix.'_'.$name;
+            $out .= "# HELP $name $help\n";
+            $out .= "# TYPE $name $type\n";
+            foreach($snapshot[$key] as $label_value => $value) {
+                $sample_labels = array_merge($labels, [$label_name => (string)$label_value]);
+                $out .= $name.self::formatLabels($sample_labels).' '.$value."\n";
+            }
+        }
+        return $out;
+    }
+
+    /**
+     * @param array<string,string> $labels
+     */
+    private static function formatLabels(array $labels) : string
+    {
+        $items = [];
+        foreach($labels as $name => $value) {
+            $value = str_replace(['\\', '"', "\n"], ['\\\\', '\\"', '\\n'], $value);
+            $items[] = $name.'="'.$value.'"';
+        }
+        return '{'.implode(',',$items).'}';
+    }
+}
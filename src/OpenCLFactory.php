@@ -6,8 +6,11 @@ use FFI;
 //use FFI\Env\Status as FFIEnvStatus;
 //use FFI\Location\Locator as FFIEnvLocator;
 use Interop\Polite\Math\Matrix\LinearBuffer as HostBuffer;
+use Interop\Polite\Math\Matrix\OpenCL;
 use FFI\Exception as FFIException;
+use InvalidArgumentException;
 use RuntimeException;
+use WeakMap;
 
 class OpenCLFactory
 {
@@ -20,6 +23,18 @@ class OpenCLFactory
     private static ?string $statusMessage = null;
     private static int $status = 0;
 
+    // Process-wide shared resources for long-running workers
+    /** @var array<string,Context> $sharedContexts */
+    private static array $sharedContexts = [];
+    // keyed by the key of the shared context. A WeakMap cannot be used because
+    // the CommandQueue references its Context and would keep the key alive.
+    /** @var array<string,array<string,CommandQueue>> $sharedQueues */
+    private static array $sharedQueues = [];
+    /** @var ?WeakMap<Context,array<string,Program>> $sharedPrograms */
+    private static ?WeakMap $sharedPrograms = null;
+    /** @var ?WeakMap<Program,array<string,Kernel>> $sharedKernels */
+    private static ?WeakMap $sharedKernels = null;
+
     /** @var array<string> $libs_win */
     protected array $libs_win = ['OpenCL.dll'];
     /** @var array<string> $libs_linux */
@@ -196,4 +211,191 @@ class OpenCLFactory
         }
         return new Kernel(self::$ffi, $program, $kernelName);
     }
+
+    /**
+     * Returns the Context shared by the whole process.
+     * The same Context is returned for the same device type or the same devices.
+     */
+    public function sharedContext(
+        DeviceList|int $arg
+    ) : Context
+    {
+        if(self::$ffi==null) {
+            throw new RuntimeException($this->getStatusMessage());
+        }
+        if($arg instanceof DeviceList) {
+            $key = 'devices:'.$this->handleKey(self::$ffi,$arg->_getIds(),count($arg));
+        } else {
+            $key = 'type:'.$arg;
+        }
+        if(!isset(self::$sharedContexts[$key])) {
+            self::$sharedContexts[$key] = new Context(self::$ffi,$arg);
+        }
+        return self::$sharedContexts[$key];
+    }
+
+    /**
+     * Returns the CommandQueue shared by the whole process for the context and device.
+     * The context must be the one returned by sharedContext().
+     */
+    public function sharedCommandQueue(
+        Context $context,
+        ?object $deviceId=null,
+    ) : CommandQueue
+    {
+        if(self::$ffi==null) {
+            throw new RuntimeException($this->getStatusMessage());
+        }
+        $contextKey = array_search($context,self::$sharedContexts,true);
+        if($contextKey===false) {
+            throw new InvalidArgumentException("the context is not a shared context.", OpenCL::CL_INVALID_CONTEXT);
+        }
+        if($deviceId===null) {
+            // the same device as the default of CommandQueue
+            $deviceId = $context->_getDeviceIds()[0];
+        }
+        $key = $this->handleKey(self::$ffi,FFI::addr($deviceId),1);
+        if(!isset(self::$sharedQueues[$contextKey][$key])) {
+            self::$sharedQueues[$contextKey][$key] = new CommandQueue(self::$ffi, $context, $deviceId);
+        }
+        return self::$sharedQueues[$contextKey][$key];
+    }
+
+    /**
+     * Returns the built Program shared by the whole process.
+     * Programs are keyed by the context, the hash of the source codes and the build options.
+     *
+     * @param string|array<string> $source
+     */
+    public function sharedProgram(
+        Context $context,
+        string|array $source,
+        ?string $options=null,
+    ) : Program
+    {
+        if(self::$ffi==null) {
+            throw new RuntimeException($this->getStatusMessage());
+        }
+        $programs = self::$sharedPrograms ??= new WeakMap();
+        $key = $this->sourceKey($source,$options);
+        $entries = $programs[$context] ?? [];
+        if(!isset($entries[$key])) {
+            $program = new Program(self::$ffi, $context, $source);
+            $program->build($options);
+            $entries[$key] = $program;
+            $programs[$context] = $entries;
+        }
+        return $entries[$key];
+    }
+
+    /**
+     * Returns the Kernel shared by the whole process for the program and kernel name.
+     * Kernel arguments are not reset, so set all arguments before each enqueue.
+     */
+    public function sharedKernel(
+        Program $program,
+        string $kernelName,
+    ) : Kernel
+    {
+        if(self::$ffi==null) {
+            throw new RuntimeException($this->getStatusMessage());
+        }
+        $kernels = self::$sharedKernels ??= new WeakMap();
+        $entries = $kernels[$program] ?? [];
+        if(!isset($entries[$kernelName])) {
+            $entries[$kernelName] = new Kernel(self::$ffi, $program, $kernelName);
+            $kernels[$program] = $entries;
+        }
+        return $entries[$kernelName];
+    }
+
+    /**
+     * Builds the shared programs one by one at the start of the worker,
+     * so that the first request does not wait for the compilation.
+     * A source that is already shared or given twice is built only once.
+     *
+     * @param array<string|array<string>> $sources
+     * @return array<Program>
+     */
+    public function warmUpShared(
+        Context $context,
+        array $sources,
+        ?string $options=null,
+    ) : array
+    {
+        if(self::$ffi==null) {
+            throw new RuntimeException($this->getStatusMessage());
+        }
+        $programs = self::$sharedPrograms ??= new WeakMap();
+        $entries = $programs[$context] ?? [];
+        $results = [];
+        $built = [];
+        foreach($sources as $name => $source) {
+            $key = $this->sourceKey($source,$options);
+            if(isset($entries[$key])) {
+                $results[$name] = $entries[$key];
+                continue;
+            }
+            // the same source given twice shares one program
+            if(!isset($built[$key])) {
+                $program = new Program(self::$ffi, $context, $source);
+                $program->build($options);
+                $built[$key] = $program;
+            }
+            $results[$name] = $built[$key];
+        }
+        foreach($built as $key => $program) {
+            $entries[$key] = $program;
+        }
+        $programs[$context] = $entries;
+        return $results;
+    }
+
+    /**
+     * Releases the shared programs and kernels.
+     * Shared contexts and command queues are kept.
+     */
+    public function resetShared() : void
+    {
+        self::$sharedKernels = null;
+        self::$sharedPrograms = null;
+    }
+
+    /**
+     * Releases all shared resources at the end of the worker.
+     */
+    public function shutdownShared() : void
+    {
+        foreach(self::$sharedQueues as $entries) {
+            foreach($entries as $queue) {
+                $queue->finish();
+            }
+        }
+        self::$sharedKernels = null;
+        self::$sharedPrograms = null;
+        self::$sharedQueues = [];
+        self::$sharedContexts = [];
+    }
+
+    /**
+     * @param string|array<string> $source
+     */
+    private function sourceKey(string|array $source, ?string $options) : string
+    {
+        if(is_string($source)) {
+            $source = [$source];
+        }
+        return sha1(implode("\0",$source))."|".($options??'');
+    }
+
+    private function handleKey(FFI $ffi, object $ids, int $num) : string
+    {
+        $handles = $ffi->new("size_t[$num]");
+        FFI::memcpy($handles,$ids,FFI::sizeof($handles));
+        $keys = [];
+        for($i=0;$i<$num;$i++) {
+            $keys[] = dechex($handles[$i]);
+        }
+        return implode(',',$keys);
+    }
 }
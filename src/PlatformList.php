@@ -24,13 +24,17 @@ class PlatformList implements Countable
             return;
         }
         $numPlatforms = $ffi->new("cl_uint[1]");
+        $call_start = hrtime(true);
         $errcode_ret = $ffi->clGetPlatformIDs(0, NULL, $numPlatforms);
+        Metrics::call('clGetPlatformIDs',$call_start);
         if($errcode_ret!=OpenCL::CL_SUCCESS) {
             throw new RuntimeException("clGetPlatformIDs Error errcode=$errcode_ret");
         }
         $num = $numPlatforms[0];
         $platforms = $ffi->new("cl_platform_id[$num]");
+        $call_start = hrtime(true);
         $errcode_ret = $ffi->clGetPlatformIDs($num, $platforms, $numPlatforms);
+        Metrics::call('clGetPlatformIDs',$call_start);
         if($errcode_ret!=OpenCL::CL_SUCCESS) {
             throw new RuntimeException("clGetPlatformIDs Error2 errcode=$errcode_ret");
         }
@@ -72,8 +76,10 @@ class PlatformList implements Countable
         }
         $id = $this->platforms[$offset];
         $param_value_size_ret = $ffi->new("size_t[1]");
+        $call_start = hrtime(true);
         $errcode_ret = $ffi->clGetPlatformInfo($id, $param_name,
                                 0, NULL, $param_value_size_ret);
+        Metrics::call('clGetPlatformInfo',$call_start);
         if($errcode_ret!=OpenCL::CL_SUCCESS) {
             throw new RuntimeException("clGetPlatformInfo Error errcode=$errcode_ret");
         }
@@ -85,9 +91,11 @@ class PlatformList implements Countable
             case OpenCL::CL_PLATFORM_EXTENSIONS: {
                 $size = $param_value_size_ret[0];
                 $param_value_val = $ffi->new("cl_char[$size]");
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetPlatformInfo($id,
                                         $param_name,
                                         $size, $param_value_val, NULL);
+                Metrics::call('clGetPlatformInfo',$call_start);
                 if($errcode_ret!=OpenCL::CL_SUCCESS) {
                     throw new RuntimeException("clGetPlatformInfo Error errcode=$errcode_ret");
                 }
@@ -57,16 +57,19 @@ class Program
                 [$num_strings, $strings, $lengths, $source_objs] = $this->array_to_strings($source,$mode);
                 $errcode_ret = $ffi->new('cl_int[1]');
                 if($mode==self::TYPE_SOURCE_CODE) {  // source mode
+                    $call_start = hrtime(true);
                     $program = $ffi->clCreateProgramWithSource(
                         $context->_getId(),
                         $num_strings,
                         $strings,
                         $lengths,
                         $errcode_ret);
+                    Metrics::call('clCreateProgramWithSource',$call_start);
                     if($errcode_ret[0]!=OpenCL::CL_SUCCESS) {
                         throw new RuntimeException("clCreateProgramWithSource Error errcode=".$errcode_ret[0]);
                     }
                 } else {  // binary mode
+                    $call_start = hrtime(true);
                     $program = $ffi->clCreateProgramWithBinary(
                         $context->_getId(),
                         $num_strings,
@@ -75,6 +78,7 @@ class Program
                         $strings,
                         NULL,                 // cl_int * binary_status,
                         $errcode_ret);
+                    Metrics::call('clCreateProgramWithBinary',$call_start);
                     if($errcode_ret[0]!=OpenCL::CL_SUCCESS) {
                         throw new RuntimeException("clCreateProgramWithBinary Error errcode=".$errcode_ret[0]);
                     }
@@ -88,12 +92,14 @@ class Program
                 }
                 $kernel_names = $source;
                 $errcode_ret = $ffi->new('cl_int[1]');
+                $call_start = hrtime(true);
                 $program = $ffi->clCreateProgramWithBuiltInKernels(
                     $context->_getId(),
                     $num_devices,
                     $devices,
                     $kernel_names,
                     $errcode_ret);
+                Metrics::call('clCreateProgramWithBuiltInKernels',$call_start);
                 if($errcode_ret[0]!=OpenCL::CL_SUCCESS) {
                     throw new RuntimeException("clCreateProgramWithBuiltInKernels Error errcode=".$errcode_ret[0]);
                 }
@@ -106,6 +112,7 @@ class Program
                 $num_input_programs = [];
                 [$num_input_programs,$input_programs,$objs] = $this->array_to_programs($source);
                 $errcode_ret = $ffi->new('cl_int[1]');
+                $call_start = hrtime(true);
                 $program = $ffi->clLinkProgram(
                     $context->_getId(),
                     $num_devices,
@@ -117,6 +124,7 @@ class Program
                     NULL,        // void * user_data
                     $errcode_ret
                 );
+                Metrics::call('clLinkProgram',$call_start);
                 if($errcode_ret[0]!=OpenCL::CL_SUCCESS) {
                     throw new RuntimeException("clLinkProgram Error errcode=".$errcode_ret[0]);
                 }
@@ -128,12 +136,16 @@ class Program
             }
         } // end switch
         $this->program = $program;
+        Metrics::created('Program');
     }
 
     public function __destruct()
     {
         if($this->program) {
+            Metrics::released('Program');
+            $call_start = hrtime(true);
             $errcode_ret = $this->ffi->clReleaseProgram($this->program);
+            Metrics::call('clReleaseProgram',$call_start);
             $this->program = null;
             if($errcode_ret!=OpenCL::CL_SUCCESS) {
                 echo "WARNING: clReleaseProgram error=$errcode_ret\n";
@@ -146,6 +158,11 @@ class Program
         return $this->program;
     }
 
+    /**
+     * Builds are synchronous. pfn_notify is always NULL because a PHP closure
+     * must not be called from the driver's own threads, and the loaders offer
+     * no native no-op callback that is safe to pass instead.
+     */
     public function build(
         ?string $options=NULL,
         ?DeviceList $device_list=NULL,
@@ -164,6 +181,7 @@ class Program
             $options_obj = $ffi->new("char[$len]");
             FFI::memcpy($options_obj,$options."\0",$len);
         }
+        $call_start = hrtime(true);
         $errcode_ret = $ffi->clBuildProgram(
             $this->program,
             $num_devices,
@@ -172,6 +190,7 @@ class Program
             NULL,        // CL_CALLBACK *  pfn_notify
             NULL         // void * user_data
         );
+        Metrics::call('clBuildProgram',$call_start);
         if($errcode_ret!=OpenCL::CL_SUCCESS) {
             throw new RuntimeException("clBuildProgram Error errcode=".$errcode_ret,$errcode_ret);
         }
@@ -200,6 +219,7 @@ class Program
             $devices = $device_list->_getIds();
             $num_devices = count($devices);
         }
+        $call_start = hrtime(true);
         $errcode_ret = $ffi->clCompileProgram(
             $this->program,
             $num_devices,
@@ -211,6 +231,7 @@ class Program
             NULL,        // CL_CALLBACK *  pfn_notify
             NULL         // void * user_data
         );
+        Metrics::call('clCompileProgram',$call_start);
         if($errcode_ret!=OpenCL::CL_SUCCESS) {
             throw new RuntimeException("clCompileProgram Error errcode=".$errcode_ret,$errcode_ret);
         }
@@ -223,11 +244,13 @@ class Program
     {
         $ffi = $this->ffi;
         $param_value_size_ret = $ffi->new("size_t[1]");
+        $call_start = hrtime(true);
         $errcode_ret = $ffi->clGetProgramInfo($this->program,
                                 $param_name,
                                 0,
                                 NULL,
                                 $param_value_size_ret);
+        Metrics::call('clGetProgramInfo',$call_start);
         if($errcode_ret!=OpenCL::CL_SUCCESS) {
             throw new RuntimeException("clGetProgramInfo Error errcode=$errcode_ret");
         }
@@ -239,9 +262,11 @@ class Program
                 if($size!=$ffi::sizeof($uint_result)) {
                     throw new RuntimeException("clGetProgramInfo illegal uint size=$size");
                 }
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetProgramInfo($this->program,
                                         $param_name,
                                         $size, $uint_result, NULL);
+                Metrics::call('clGetProgramInfo',$call_start);
                 if($errcode_ret!=OpenCL::CL_SUCCESS) {
                     throw new RuntimeException("clGetProgramInfo Error2 errcode=$errcode_ret");
                 }
@@ -258,9 +283,11 @@ class Program
                 if($size!=$ffi::sizeof($size_t_result)) {
                     throw new RuntimeException("clGetProgramInfo illegal uint or size_t size=$size");
                 }
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetProgramInfo($this->program,
                                         $param_name,
                                         $size, $size_t_result, NULL);
+                Metrics::call('clGetProgramInfo',$call_start);
                 if($errcode_ret!=OpenCL::CL_SUCCESS) {
                     throw new RuntimeException("clGetProgramInfo Error2 errcode=$errcode_ret");
                 }
@@ -273,9 +300,11 @@ class Program
             case OpenCL::CL_PROGRAM_SOURCE: {
                 $size = $param_value_size_ret[0];
                 $param_value = $ffi->new("char[$size]");
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetProgramInfo($this->program,
                                     $param_name,
                                     $size, $param_value, NULL);
+                Metrics::call('clGetProgramInfo',$call_start);
                 if($errcode_ret!=OpenCL::CL_SUCCESS) {
                     throw new RuntimeException("clGetProgramInfo Error errcode=$errcode_ret");
                 }
@@ -290,9 +319,11 @@ class Program
                     throw new RuntimeException("clGetProgramInfo illegal array<cl_device_id> size=$size");
                 }
                 $device_ids = $ffi->new("cl_device_id[$items]");
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetProgramInfo($this->program,
                             $param_name,
                             $size, $device_ids, NULL);
+                Metrics::call('clGetProgramInfo',$call_start);
                 if($errcode_ret!=OpenCL::CL_SUCCESS) {
                     throw new RuntimeException("clGetProgramInfo Error errcode=$errcode_ret");
                 }
@@ -311,9 +342,11 @@ class Program
                 }
                 $items = $size/$sizeofItem;
                 $param_value_val = $ffi->new("size_t[$items]");
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetProgramInfo($this->program,
                                         $param_name,
                                         $size, $param_value_val, NULL);
+                Metrics::call('clGetProgramInfo',$call_start);
                 if($errcode_ret!=OpenCL::CL_SUCCESS) {
                     throw new RuntimeException("clGetProgramInfo Error errcode=$errcode_ret");
                 }
@@ -351,10 +384,12 @@ class Program
         $device = $devices[$device_index];
     
         $param_value_size_ret = $ffi->new("size_t[1]");
+        $call_start = hrtime(true);
         $errcode_ret = $ffi->clGetProgramBuildInfo($this->program,
                                 $device,
                                 $param_name,
                                 0, NULL, $param_value_size_ret);
+        Metrics::call('clGetProgramBuildInfo',$call_start);
         if($errcode_ret!=OpenCL::CL_SUCCESS) {
             throw new RuntimeException("clGetProgramBuildInfo Error errcode=$errcode_ret");
         }
@@ -366,10 +401,12 @@ class Program
                 if($size!=$ffi::sizeof($param_value_val)) {
                     throw new RuntimeException("clGetProgramBuildInfo illegal int size=$size");
                 }
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetProgramBuildInfo($this->program,
                                         $device,
                                         $param_name,
                                         $size, $param_value_val, NULL);
+                Metrics::call('clGetProgramBuildInfo',$call_start);
                 if($errcode_ret!=OpenCL::CL_SUCCESS) {
                     throw new RuntimeException("clGetProgramBuildInfo Error2 errcode=$errcode_ret");
                 }
@@ -382,10 +419,12 @@ class Program
                 if($size!=$ffi::sizeof($param_value_val)) {
                     throw new RuntimeException("clGetProgramBuildInfo illegal uint size=$size");
                 }
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetProgramBuildInfo($this->program,
                                         $device,
                                         $param_name,
                                         $size, $param_value_val, NULL);
+                Metrics::call('clGetProgramBuildInfo',$call_start);
                 if($errcode_ret!=OpenCL::CL_SUCCESS) {
                     throw new RuntimeException("clGetProgramBuildInfo Error2 errcode=$errcode_ret");
                 }
@@ -396,10 +435,12 @@ class Program
             case OpenCL::CL_PROGRAM_BUILD_LOG: {
                 $size = $param_value_size_ret[0];
                 $param_value_val = $ffi->new("cl_char[$size]");
+                $call_start = hrtime(true);
                 $errcode_ret = $ffi->clGetProgramBuildInfo($this->program,
                                         $device,
                                         $param_name,
                                         $size, $param_value_val, NULL);
+                Metrics::call('clGetProgramBuildInfo',$call_start);
                 if($errcode_ret!=OpenCL::CL_SUCCESS) {
                     throw new RuntimeException("clGetProgramBuildInfo Error2 errcode=$errcode_ret");
                 }
@@ -0,0 +1,178 @@
+<?php
+namespace Rindow\OpenCL\FFI;
+
+use Interop\Polite\Math\Matrix\OpenCL;
+use InvalidArgumentException;
+use RuntimeException;
+use FFI;
+
+/**
+ * Merges small non-blocking writes of a CommandQueue into one upload.
+ *
+ * The written data is copied into a host staging arena. On flush, the arena is
+ * uploaded to a device staging buffer by one clEnqueueWriteBuffer and scattered
+ * to the destination buffers by clEnqueueCopyBuffer. Consecutive writes to
+ * contiguous ranges of the same buffer share one copy.
+ * The command queue must be in-order so that the staging buffer can be reused.
+ */
+class WriteCombiner
+{
+    protected FFI $ffi;
+    protected Buffer $staging;
+    protected int $capacity;
+    protected int $max_write_size;
+    protected int $max_in_flight = 2;
+    protected ?object $arena = null;
+    protected int $used = 0;
+    /** @var array<array{Buffer,int,int,int}> $pending  [buffer, staging offset, buffer offset, size] */
+    protected array $pending = [];
+    /** @var array<array{EventList,object}> $in_flight  [upload event, arena] */
+    protected array $in_flight = [];
+
+    public function __construct(FFI $ffi,
+        Context $context,
+        ?int $capacity=null,
+        ?int $max_write_size=null,
+        )
+    {
+        $capacity = $capacity ?? 65536;
+        $max_write_size = $max_write_size ?? 256;
+        if($capacity<=0) {
+            throw new InvalidArgumentException("capacity must be greater zero.", OpenCL::CL_INVALID_VALUE);
+        }
+        if($max_write_size<=0 || $max_write_size>$capacity) {
+            throw new InvalidArgumentException("max_write_size must be greater zero and less than or equal capacity.", OpenCL::CL_INVALID_VALUE);
+        }
+        $this->ffi = $ffi;
+        $this->capacity = $capacity;
+        $this->max_write_size = $max_write_size;
+        $this->staging = new Buffer($ffi, $context, $capacity, OpenCL::CL_MEM_READ_ONLY);
+    }
+
+    public function capacity() : int
+    {
+        return $this->capacity;
+    }
+
+    public function maxWriteSize() : int
+    {
+        return $this->max_write_size;
+    }
+
+    public function pendingBytes() : int
+    {
+        return $this->used;
+    }
+
+    /**
+     * Copy the data into the arena. Returns false when the write is too large to be combined.
+     */
+    public function append(
+        CommandQueue $command_queue,
+        Buffer $buffer,
+        object $host_ptr,
+        int $size,
+        int $offset,
+    ) : bool
+    {
+        if($size>$this->max_write_size) {
+            return false;
+        }
+        if($this->used+$size > $this->capacity) {
+            $this->flush($command_queue);
+        }
+        if($this->arena===null) {
+            $this->arena = $this->ffi->new("uint8_t[{$this->capacity}]");
+        }
+        $dst = $this->ffi->cast('uint8_t *',FFI::addr($this->arena)) + $this->used;
+        FFI::memcpy($dst,$host_ptr,$size);
+        $this->pending[] = [$buffer,$this->used,$offset,$size];
+        $this->used += $size;
+        return true;
+    }
+
+    public function flush(CommandQueue $command_queue) : void
+    {
+        if(count($this->pending)==0) {
+            return;
+        }
+        $ffi = $this->ffi;
+        $queue_id = $command_queue->_getRawId();
+        $staging_id = $this->staging->_getId();
+        $arena = $this->arena;
+        $used = $this->used;
+        $pending = $this->pending;
+        $this->arena = null;
+        $this->used = 0;
+        $this->pending = [];
+
+        $event_p = $ffi->new("cl_event[1]");
+        $call_start = hrtime(true);
+        $errcode_ret = $ffi->clEnqueueWriteBuffer(
+            $queue_id,
+            $staging_id,
+            0,          // non-blocking
+            0,
+            $used,
+            $arena,
+            0,
+            NULL,
+            $event_p);
+        Metrics::call('clEnqueueWriteBuffer',$call_start);
+        if($errcode_ret!=OpenCL::CL_SUCCESS) {
+            throw new RuntimeException("clEnqueueWriteBuffer Error errcode=".$errcode_ret, $errcode_ret);
+        }
+        // the arena must be kept until the upload is completed
+        $events = new EventList($ffi);
+        $events->_move($event_p);
+        $this->in_flight[] = [$events,$arena];
+
+        // consecutive writes to contiguous ranges of the same buffer are scattered by one copy
+        $copies = [];
+        $last = -1;
+        foreach($pending as [$buffer,$src_offset,$dst_offset,$size]) {
+            if($last>=0) {
+                [$last_buffer,$last_src_offset,$last_dst_offset,$last_size] = $copies[$last];
+                if($last_buffer===$buffer &&
+                    $last_src_offset+$last_size==$src_offset &&
+                    $last_dst_offset+$last_size==$dst_offset) {
+                    $copies[$last][3] += $size;
+                    continue;
+                }
+            }
+            $copies[] = [$buffer,$src_offset,$dst_offset,$size];
+            $last++;
+        }
+
+        foreach($copies as [$buffer,$src_offset,$dst_offset,$size]) {
+            $call_start = hrtime(true);
+            $errcode_ret = $ffi->clEnqueueCopyBuffer(
+                $queue_id,
+                $staging_id,
+                $buffer->_getId(),
+                $src_offset,
+                $dst_offset,
+                $size,
+                0,
+                NULL,
+                NULL);
+            Metrics::call('clEnqueueCopyBuffer',$call_start);
+            if($errcode_ret!=OpenCL::CL_SUCCESS) {
+                throw new RuntimeException("clEnqueueCopyBuffer Error errcode=".$errcode_ret, $errcode_ret);
+            }
+        }
+
+        while(count($this->in_flight)>$this->max_in_flight) {
+            [$events,$arena] = array_shift($this->in_flight);
+            $events->wait();
+        }
+    }
+
+    /**
+     * Release the arenas after all commands in the queue are completed.
+     */
+    public function _release() : void
+    {
+        $this->in_flight = [];
+    }
+}
@@ -6,6 +6,7 @@ use Interop\Polite\Math\Matrix\NDArray;
 use Interop\Polite\Math\Matrix\OpenCL;
 use Rindow\Math\Buffer\FFI\BufferFactory;
 use Rindow\OpenCL\FFI\OpenCLFactory;
+use Rindow\OpenCL\FFI\Metrics;
 
 use TypeError;
 use RuntimeException;
@@ -106,6 +107,100 @@ class BufferTest extends TestCase
         $this->assertTrue($buffer->value_size()==(32/8));
     }
 
+    /**
+     * combined writes
+     */
+    public function testWriteCombining()
+    {
+        $ocl = $this->newDriverFactory();
+        $context = $this->newContextFromType($ocl);
+        $queue = $ocl->CommandQueue($context);
+        $queue->enableWriteCombining(capacity:64,max_write_size:16);
+        $combiner = $queue->_getWriteCombiner();
+        $hostBufferFactory = $this->newHostBufferFactory();
+
+        $buffers = [];
+        for($i=0;$i<8;$i++) {
+            $hostBuffer = $hostBufferFactory->Buffer(4,NDArray::float32);
+            foreach(range(0,3) as $value) {
+                $hostBuffer[$value] = $i*10+$value;
+            }
+            $buffer = $ocl->Buffer($context,intval(4*32/8),
+                OpenCL::CL_MEM_READ_WRITE);
+            $buffer->write($queue,$hostBuffer,blocking_write:false);
+            // the host data is copied into the arena
+            $hostBuffer[0] = -1;
+            $this->assertTrue($buffer->dtype()==NDArray::float32);
+            $buffers[] = $buffer;
+        }
+        // 8 writes of 16 bytes overflow the 64 bytes arena once
+        $this->assertEquals(64,$combiner->pendingBytes());
+
+        // reading flushes the combined writes first
+        $hostBuffer = $hostBufferFactory->Buffer(4,NDArray::float32);
+        foreach($buffers as $i => $buffer) {
+            $buffer->read($queue,$hostBuffer);
+            $this->assertEquals(0,$combiner->pendingBytes());
+            foreach(range(0,3) as $value) {
+                $this->assertEquals($i*10+$value,$hostBuffer[$value]);
+            }
+        }
+
+        // large or blocking writes are not combined
+        $hostBuffer = $hostBufferFactory->Buffer(16,NDArray::float32);
+        $buffer = $ocl->Buffer($context,intval(16*32/8),
+            OpenCL::CL_MEM_READ_WRITE);
+        $buffer->write($queue,$hostBuffer,blocking_write:false);
+        $this->assertEquals(0,$combiner->pendingBytes());
+        $buffers[0]->write($queue,$hostBuffer,size:16);
+        $this->assertEquals(0,$combiner->pendingBytes());
+
+        // the native handle for other libraries flushes the combined writes
+        $hostBuffer = $hostBufferFactory->Buffer(4,NDArray::float32);
+        $buffers[0]->write($queue,$hostBuffer,blocking_write:false);
+        $this->assertEquals(16,$combiner->pendingBytes());
+        $queue->_getId();
+        $this->assertEquals(0,$combiner->pendingBytes());
+
+        $queue->finish();
+        $queue->disableWriteCombining();
+        $this->assertNull($queue->_getWriteCombiner());
+    }
+
+    /**
+     * contiguous combined writes are scattered by one copy
+     */
+    public function testWriteCombiningMergesContiguousWrites()
+    {
+        $ocl = $this->newDriverFactory();
+        $context = $this->newContextFromType($ocl);
+        $queue = $ocl->CommandQueue($context);
+        $queue->enableWriteCombining();
+        $hostBufferFactory = $this->newHostBufferFactory();
+
+        $buffer = $ocl->Buffer($context,intval(16*32/8),
+            OpenCL::CL_MEM_READ_WRITE);
+        Metrics::reset();
+        for($i=0;$i<4;$i++) {
+            $hostBuffer = $hostBufferFactory->Buffer(4,NDArray::float32);
+            foreach(range(0,3) as $value) {
+                $hostBuffer[$value] = $i*4+$value;
+            }
+            $buffer->write($queue,$hostBuffer,offset:$i*16,blocking_write:false);
+        }
+        $queue->finish();
+
+        $snapshot = Metrics::snapshot();
+        $this->assertEquals(1,$snapshot['calls']['clEnqueueWriteBuffer']);
+        $this->assertEquals(1,$snapshot['calls']['clEnqueueCopyBuffer']);
+
+        $hostBuffer = $hostBufferFactory->Buffer(16,NDArray::float32);
+        $buffer->read($queue,$hostBuffer);
+        foreach(range(0,15) as $value) {
+            $this->assertEquals($value,$hostBuffer[$value]);
+        }
+    }
+
     /**
      * construct buffer with null
      */
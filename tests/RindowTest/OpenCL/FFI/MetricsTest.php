@@ -0,0 +1,147 @@
+<?php
+namespace RindowTest\OpenCL\FFI\MetricsTest;
+
+use PHPUnit\Framework\TestCase;
+use Interop\Polite\Math\Matrix\NDArray;
+use Interop\Polite\Math\Matrix\OpenCL;
+use Rindow\Math\Buffer\FFI\BufferFactory;
+use Rindow\OpenCL\FFI\OpenCLFactory;
+use Rindow\OpenCL\FFI\Metrics;
+use RuntimeException;
+use InvalidArgumentException;
+
+class MetricsTest extends TestCase
+{
+    static protected int $default_device_type = OpenCL::CL_DEVICE_TYPE_GPU;
+
+    public function newDriverFactory()
+    {
+        $factory = new OpenCLFactory();
+        return $factory;
+    }
+
+    public function newContextFromType($ocl)
+    {
+        try {
+            $context = $ocl->Context(self::$default_device_type);
+        } catch(RuntimeException $e) {
+            if(strpos('clCreateContextFromType',$e->getMessage())===null) {
+                throw $e;
+            }
+            self::$default_device_type = OpenCL::CL_DEVICE_TYPE_DEFAULT;
+            $context = $ocl->Context(self::$default_device_type);
+        }
+        return $context;
+    }
+
+    public function newHostBufferFactory()
+    {
+        $factory = new BufferFactory();
+        return $factory;
+    }
+
+    public function testCounters()
+    {
+        $ocl = $this->newDriverFactory();
+        $context = $this->newContextFromType($ocl);
+        $queue = $ocl->CommandQueue($context);
+        Metrics::reset();
+        $live = Metrics::snapshot()['objects_live']['Buffer'] ?? 0;
+
+        $hostBuffer = $this->newHostBufferFactory()->Buffer(16,NDArray::float32);
+        $buffer = $ocl->Buffer($context,intval(16*32/8),
+            OpenCL::CL_MEM_READ_WRITE);
+        $buffer->write($queue,$hostBuffer);
+        $buffer->read($queue,$hostBuffer,size:32);
+
+        $snapshot = Metrics::snapshot();
+        $this->assertEquals(1,$snapshot['calls']['clCreateBuffer']);
+        $this->assertEquals(1,$snapshot['calls']['clEnqueueWriteBuffer']);
+        $this->assertEquals(1,$snapshot['calls']['clEnqueueReadBuffer']);
+        $this->assertGreaterThan(0,$snapshot['call_seconds']['clEnqueueReadBuffer']);
+        $this->assertEquals(64,$snapshot['bytes']['write']);
+        $this->assertEquals(32,$snapshot['bytes']['read']);
+        $this->assertEquals(1,$snapshot['objects_created']['Buffer']);
+        $this->assertEquals($live+1,$snapshot['objects_live']['Buffer']);
+
+        unset($buffer);
+        $snapshot = Metrics::snapshot();
+        $this->assertEquals($live,$snapshot['objects_live']['Buffer']);
+        $this->assertEquals(1,$snapshot['calls']['clReleaseMemObject']);
+    }
+
+    public function testInfoQueries()
+    {
+        $ocl = $this->newDriverFactory();
+        $context = $this->newContextFromType($ocl);
+        Metrics::reset();
+
+        $platforms = $ocl->PlatformList();
+        $context->getInfo(OpenCL::CL_CONTEXT_NUM_DEVICES);
+
+        $snapshot = Metrics::snapshot();
+        $this->assertEquals(2,$snapshot['calls']['clGetPlatformIDs']);
+        $this->assertEquals(2,$snapshot['calls']['clGetContextInfo']);
+        $this->assertArrayHasKey('clGetContextInfo',$snapshot['call_seconds']);
+    }
+
+    public function testKernelLaunches()
+    {
+        $ocl = $this->newDriverFactory();
+        $context = $this->newContextFromType($ocl);
+        $queue = $ocl->CommandQueue($context);
+        $sources = [
+            "__kernel void scale(__global float * y,\n".
+            "                    const float a)\n".
+            "{\n".
+            "   uint gid = get_global_id(0);\n".
+            "   y[gid] = a * y[gid];\n".
+            "}\n"
+        ];
+        $program = $ocl->Program($context,$sources);
+        $program->build();
+        $kernel = $ocl->Kernel($program,"scale");
+        $buffer = $ocl->Buffer($context,intval(16*32/8),
+            OpenCL::CL_MEM_READ_WRITE);
+        Metrics::reset();
+
+        $kernel->setArg(0,$buffer);
+        $kernel->setArg(1,2.0,NDArray::float32);
+        $kernel->enqueueNDRange($queue,[16]);
+        $kernel->enqueueNDRange($queue,[16]);
+        $queue->finish();
+
+        $snapshot = Metrics::snapshot();
+        $this->assertEquals(2,$snapshot['kernel_launches']['scale']);
+        $this->assertEquals(2,$snapshot['calls']['clSetKernelArg']);
+        $this->assertEquals(2,$snapshot['calls']['clEnqueueNDRangeKernel']);
+        $this->assertEquals(1,$snapshot['calls']['clFinish']);
+    }
+
+    public function testPrometheus()
+    {
+        Metrics::reset();
+        Metrics::call('clFlush',hrtime(true));
+        Metrics::bytes('write',128);
+        Metrics::launch('my"kernel');
+
+        $text = Metrics::toPrometheus(labels:['worker'=>'1']);
+        $this->assertStringContainsString("# TYPE rindow_opencl_calls_total counter\n",$text);
+        $this->assertStringContainsString("rindow_opencl_calls_total{worker=\"1\",function=\"clFlush\"} 1\n",$text);
+        $this->assertStringContainsString("rindow_opencl_transfer_bytes_total{worker=\"1\",operation=\"write\"} 128\n",$text);
+        $this->assertStringContainsString("rindow_opencl_kernel_launches_total{worker=\"1\",kernel=\"my\\\"kernel\"} 1\n",$text);
+        $this->assertStringContainsString("# TYPE rindow_opencl_objects_live gauge\n",$text);
+    }
+
+    public function testPrometheusReservedLabel()
+    {
+        $this->expectException(InvalidArgumentException::class);
+        Metrics::toPrometheus(labels:['kernel'=>'x']);
+    }
+
+    public function testPrometheusInvalidLabelName()
+    {
+        $this->expectException(InvalidArgumentException::class);
+        Metrics::toPrometheus(labels:['worker-id'=>'1']);
+    }
+}
@@ -15,7 +15,9 @@ use Rindow\OpenCL\FFI\CommandQueue;
 use Rindow\OpenCL\FFI\Program;
 use Rindow\OpenCL\FFI\Buffer as OpenCLBuffer;
 use Rindow\OpenCL\FFI\Kernel;
+use Rindow\OpenCL\FFI\Metrics;
 use RuntimeException;
+use InvalidArgumentException;
 
 class OpenCLFactoryTest extends TestCase
 {
@@ -171,4 +173,75 @@ class OpenCLFactoryTest extends TestCase
         $driver = $factory->Kernel($program,"saxpy_ext");
         $this->assertInstanceOf(Kernel::class,$driver);
     }
+
+    public function testSharedResources()
+    {
+        $factory = $this->newDriverFactory();
+        $sources = [
+            "__kernel void saxpy(const global float * x,\n".
+            "                    __global float * y,\n".
+            "                    const float a)\n".
+            "{\n".
+            "   uint gid = get_global_id(0);\n".
+            "   y[gid] = a* x[gid] + y[gid];\n".
+            "}\n"
+        ];
+        $context = $this->newContextFromType($factory);
+        $devices = $context->getInfo(OpenCL::CL_CONTEXT_DEVICES);
+
+        $context = $factory->sharedContext($devices);
+        $this->assertInstanceOf(Context::class,$context);
+        $this->assertSame($context,$factory->sharedContext($devices));
+
+        $queue = $factory->sharedCommandQueue($context);
+        $this->assertInstanceOf(CommandQueue::class,$queue);
+        $this->assertSame($queue,$factory->sharedCommandQueue($context));
+        $deviceIds = $context->_getDeviceIds();
+        $this->assertSame($queue,$factory->sharedCommandQueue($context,$deviceIds[0]));
+
+        $programs = $factory->warmUpShared($context,['saxpy'=>$sources,'dup'=>$sources]);
+        $this->assertSame($programs['saxpy'],$programs['dup']);
+        $program = $factory->sharedProgram($context,$sources);
+        $this->assertInstanceOf(Program::class,$program);
+        $this->assertSame($programs['saxpy'],$program);
+        $this->assertNotSame($program,$factory->sharedProgram($context,$sources,'-cl-fast-relaxed-math'));
+
+        $kernel = $factory->sharedKernel($program,'saxpy');
+        $this->assertInstanceOf(Kernel::class,$kernel);
+        $this->assertSame($kernel,$factory->sharedKernel($program,'saxpy'));
+
+        $factory->resetShared();
+        $this->assertNotSame($program,$factory->sharedProgram($context,$sources));
+        $this->assertSame($queue,$factory->sharedCommandQueue($context));
+
+        $factory->shutdownShared();
+        $this->assertNotSame($context,$factory->sharedContext($devices));
+        $factory->shutdownShared();
+    }
+
+    public function testSharedCommandQueueNotLeaked()
+    {
+        $factory = $this->newDriverFactory();
+        $live = Metrics::snapshot()['objects_live']['CommandQueue'] ?? 0;
+
+        // a context that is not shared is rejected and no queue is kept for it
+        $context = $this->newContextFromType($factory);
+        try {
+            $factory->sharedCommandQueue($context);
+            $this->fail('InvalidArgumentException is not thrown');
+        } catch(InvalidArgumentException $e) {
+        }
+        unset($context);
+        $this->assertEquals($live,Metrics::snapshot()['objects_live']['CommandQueue'] ?? 0);
+
+        $context = $factory->sharedContext(self::$default_device_type);
+        $queue = $factory->sharedCommandQueue($context);
+        $this->assertEquals($live+1,Metrics::snapshot()['objects_live']['CommandQueue']);
+        unset($queue);
+        $this->assertEquals($live+1,Metrics::snapshot()['objects_live']['CommandQueue']);
+
+        $factory->shutdownShared();
+        unset($context);
+        $this->assertEquals($live,Metrics::snapshot()['objects_live']['CommandQueue']);
+    }
 }